@@ -382,16 +382,15 @@ static REAL o3derrboundA, o3derrboundB, o3derrboundC;
 static REAL iccerrboundA, iccerrboundB, iccerrboundC;
 static REAL isperrboundA, isperrboundB, isperrboundC;
 
-// Options to choose types of geometric computtaions. 
-// Added by H. Si, 2012-08-23.
-static int  _use_inexact_arith; // -X option.
-static int  _use_static_filter; // Default option, disable it by -X1
+// The options to choose types of geometric computations (-X) and the static
+//   filters for orient3d() and insphere() depend on the input, they are kept
+//   in a 'predicatecontext' (see tetgen.h) which is set by exactinit().
+// The values above only depend on the machine, they are computed once (see
+//   initarithmetic()), so several threads may use the predicates at once.
 
-// Static filters for orient3d() and insphere(). 
-// They are pre-calcualted and set in exactinit().
-// Added by H. Si, 2012-08-23.
-static REAL o3dstaticfilter;
-static REAL ispstaticfilter;
+// The context of the functions without a context argument (the interface
+//   before the contexts were added).  They are not thread-safe.
+static predicatecontext defaultpredctx;
 
 
 
@@ -540,45 +539,11 @@ int test_double(int verbose)
 /*                                                                           */
 /*****************************************************************************/
 
-void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy, 
-               REAL maxz)
+static int initarithmetic(int verbose)
 {
   REAL half;
   REAL check, lastcheck;
   int every_other;
-#ifdef LINUX
-  int cword;
-#endif /* LINUX */
-
-#ifdef CPU86
-#ifdef SINGLE
-  _control87(_PC_24, _MCW_PC); /* Set FPU control word for single precision. */
-#else /* not SINGLE */
-  _control87(_PC_53, _MCW_PC); /* Set FPU control word for double precision. */
-#endif /* not SINGLE */
-#endif /* CPU86 */
-#ifdef LINUX
-#ifdef SINGLE
-  /*  cword = 4223; */
-  cword = 4210;                 /* set FPU control word for single precision */
-#else /* not SINGLE */
-  /*  cword = 4735; */
-  cword = 4722;                 /* set FPU control word for double precision */
-#endif /* not SINGLE */
-  _FPU_SETCW(cword);
-#endif /* LINUX */
-
-  if (verbose) {
-    printf("  Initializing robust predicates.\n");
-  }
-
-#ifdef USE_CGAL_PREDICATES
-  if (cgal_pred_obj.Has_static_filters) {
-    printf("  Use static filter.\n");
-  } else {
-    printf("  No static filter.\n");
-  }
-#endif // USE_CGAL_PREDICATES
 
 #ifdef SINGLE
   test_float(verbose);
@@ -621,9 +586,55 @@ void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
   isperrboundB = (5.0 + 72.0 * epsilon) * epsilon;
   isperrboundC = (71.0 + 1408.0 * epsilon) * epsilon * epsilon;
 
+  return 1;
+}
+
+void exactinit(predicatecontext *ctx, int verbose, int noexact, int nofilter,
+               REAL maxx, REAL maxy, REAL maxz)
+{
+  REAL half;
+#ifdef LINUX
+  int cword;
+#endif /* LINUX */
+
+#ifdef CPU86
+#ifdef SINGLE
+  _control87(_PC_24, _MCW_PC); /* Set FPU control word for single precision. */
+#else /* not SINGLE */
+  _control87(_PC_53, _MCW_PC); /* Set FPU control word for double precision. */
+#endif /* not SINGLE */
+#endif /* CPU86 */
+#ifdef LINUX
+#ifdef SINGLE
+  /*  cword = 4223; */
+  cword = 4210;                 /* set FPU control word for single precision */
+#else /* not SINGLE */
+  /*  cword = 4735; */
+  cword = 4722;                 /* set FPU control word for double precision */
+#endif /* not SINGLE */
+  _FPU_SETCW(cword);
+#endif /* LINUX */
+
+  if (verbose) {
+    printf("  Initializing robust predicates.\n");
+  }
+
+#ifdef USE_CGAL_PREDICATES
+  if (cgal_pred_obj.Has_static_filters) {
+    printf("  Use static filter.\n");
+  } else {
+    printf("  No static filter.\n");
+  }
+#endif // USE_CGAL_PREDICATES
+
+  // The machine-dependent values are computed by the first call only (the
+  //   initialization of a local static variable is thread-safe).
+  static int arithinit = initarithmetic(verbose);
+  (void) arithinit;
+
   // Set TetGen options.  Added by H. Si, 2012-08-23.
-  _use_inexact_arith = noexact;
-  _use_static_filter = !nofilter;
+  ctx->use_inexact_arith = noexact;
+  ctx->use_static_filter = !nofilter;
 
   // Calculate the two static filters for orient3d() and insphere() tests.
   // Added by H. Si, 2012-08-23.
@@ -639,11 +650,18 @@ void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
     half = maxy; maxy = maxx; maxx = half;
   }
 
-  o3dstaticfilter = 5.1107127829973299e-15 * maxx * maxy * maxz;
-  ispstaticfilter = 1.2466136531027298e-13 * maxx * maxy * maxz * (maxz * maxz);
+  ctx->o3dstaticfilter = 5.1107127829973299e-15 * maxx * maxy * maxz;
+  ctx->ispstaticfilter = 1.2466136531027298e-13 * maxx * maxy * maxz * 
+                         (maxz * maxz);
 
 }
 
+void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
+               REAL maxz)
+{
+  exactinit(&defaultpredctx, verbose, noexact, nofilter, maxx, maxy, maxz);
+}
+
 /*****************************************************************************/
 /*                                                                           */
 /*  grow_expansion()   Add a scalar to an expansion.                         */
@@ -2175,7 +2193,7 @@ REAL orient3dadapt(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL permanent)
 
 #ifdef USE_CGAL_PREDICATES
 
-REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
+REAL orient3d(predicatecontext *ctx, REAL *pa, REAL *pb, REAL *pc, REAL *pd)
 {
   return (REAL) 
     - cgal_pred_obj.orientation_3_object()
@@ -2187,7 +2205,7 @@ REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
 
 #else
 
-REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
+REAL orient3d(predicatecontext *ctx, REAL *pa, REAL *pb, REAL *pc, REAL *pd)
 {
   REAL adx, bdx, cdx, ady, bdy, cdy, adz, bdz, cdz;
   REAL bdxcdy, cdxbdy, cdxady, adxcdy, adxbdy, bdxady;
@@ -2217,14 +2235,14 @@ REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
       + bdz * (cdxady - adxcdy)
       + cdz * (adxbdy - bdxady);
 
-  if (_use_inexact_arith) {
+  if (ctx->use_inexact_arith) {
     return det;
   }
 
-  if (_use_static_filter) {
+  if (ctx->use_static_filter) {
     //if (fabs(det) > o3dstaticfilter) return det;
-    if (det > o3dstaticfilter) return det;
-    if (det < -o3dstaticfilter) return det;
+    if (det > ctx->o3dstaticfilter) return det;
+    if (det < -ctx->o3dstaticfilter) return det;
   }
 
 
@@ -2243,6 +2261,11 @@ REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
 
 #endif // #ifdef USE_CGAL_PREDICATES
 
+REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
+{
+  return orient3d(&defaultpredctx, pa, pb, pc, pd);
+}
+
 /*****************************************************************************/
 /*                                                                           */
 /*  incirclefast()   Approximate 2D incircle test.  Nonrobust.               */
@@ -4030,7 +4053,8 @@ REAL insphereadapt(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe,
 
 #ifdef USE_CGAL_PREDICATES
 
-REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe)
+REAL insphere(predicatecontext *ctx, REAL *pa, REAL *pb, REAL *pc, REAL *pd,
+              REAL *pe)
 {
   return (REAL)
     - cgal_pred_obj.side_of_oriented_sphere_3_object()
@@ -4043,7 +4067,8 @@ REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe)
 
 #else
 
-REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe)
+REAL insphere(predicatecontext *ctx, REAL *pa, REAL *pb, REAL *pc, REAL *pd,
+              REAL *pe)
 {
   REAL aex, bex, cex, dex;
   REAL aey, bey, cey, dey;
@@ -4101,12 +4126,12 @@ REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe)
 
   det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
 
-  if (_use_inexact_arith) {
+  if (ctx->use_inexact_arith) {
     return det;
   }
 
-  if (_use_static_filter) {
-    if (fabs(det) > ispstaticfilter) return det;
+  if (ctx->use_static_filter) {
+    if (fabs(det) > ctx->ispstaticfilter) return det;
     //if (det > ispstaticfilter) return det;
     //if (det < minus_ispstaticfilter) return det;
 
@@ -4160,6 +4185,11 @@ REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe)
 
 #endif // #ifdef USE_CGAL_PREDICATES
 
+REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe)
+{
+  return insphere(&defaultpredctx, pa, pb, pc, pd, pe);
+}
+
 /*****************************************************************************/
 /*                                                                           */
 /*  orient4d()   Return a positive value if the point pe lies above the      */
@@ -39,6 +39,15 @@
 
 #define INPUTLINESIZE 2048
 
+// Size of the stdio buffer used for writing large files (.vtk, .vtu, .mesh).
+
+#define OUTPUTBUFFERSIZE 1048576
+
+// The maximum number of objects in a leaf of the bounding volume hierarchy
+//   used by detectinterfaces() (-d) and scoutpoint().
+
+#define BVHLEAFSIZE 4
+
 // TetGen only uses the C standard library.
 
 #include <stdio.h>
@@ -47,6 +56,24 @@
 #include <math.h>
 #include <time.h>
 
+// If the compiler supports OpenMP (and it is enabled), a few loops are run
+//   in parallel. The number of threads is set by the -j switch.
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// To allocate the blocks of the memory pools from transparent huge pages
+//   (Linux only), define the TETGEN_HUGEPAGES symbol. It saves TLB misses
+//   on very large meshes, at the cost of a few MB per pool.
+
+// #define TETGEN_HUGEPAGES
+
+#if defined(TETGEN_HUGEPAGES) && defined(__linux__)
+#include <sys/mman.h>
+#define HUGEPAGESIZE 2097152
+#endif
+
 // The types 'intptr_t' and 'uintptr_t' are signed and unsigned integer types,
 //   respectively. They are guaranteed to be the same width as a pointer.
 //   They are defined in <stdint.h> by the C99 Standard. However, Microsoft 
@@ -174,6 +201,23 @@ public:
   // A callback function for mesh refinement.
   typedef bool (* TetSizeFunc)(REAL*, REAL*, REAL*, REAL*, REAL*, REAL);
 
+  // A callback function of a mesh sizing function (-m).  The arguments are
+  //   'sizehandle' and the coordinates of a point.  It returns the desired
+  //   edge length at the point, or 0 if it is not specified there.  It may
+  //   be called by several threads at the same time (-j).
+  typedef REAL (* PointSizeFunc)(void*, REAL*);
+
+  // Callback functions for streaming the output mesh in batches. They are
+  //   used in place of 'pointlist', 'tetrahedronlist', and 'trifacelist' (and
+  //   the attribute and marker lists going with them).  The arguments are
+  //   'sinkhandle', the (0-based) index of the first item in the batch, the
+  //   number of items in the batch, and the batch arrays, which are laid out
+  //   like the lists they replace.  A list which is not output is passed as
+  //   NULL.  The arrays are reused once the callback returns.
+  typedef void (* PointSinkFunc)(void*, int, int, REAL*, REAL*, int*);
+  typedef void (* TetSinkFunc)(void*, int, int, int*, REAL*);
+  typedef void (* FaceSinkFunc)(void*, int, int, int*, int*);
+
   // Items are numbered starting from 'firstnumber' (0 or 1), default is 0.
   int firstnumber; 
 
@@ -202,6 +246,16 @@ public:
   int numberofpoints;
   int numberofpointattributes;
   int numberofpointmtrs;
+
+  // 'sizegridlist':  A mesh sizing function (-m) sampled on a uniform grid
+  //   of 'sizegriddim[0]' x 'sizegriddim[1]' x 'sizegriddim[2]' nodes. The
+  //   node (i, j, k) is at 'sizegridorigin' + (i, j, k) * 'sizegridstep',
+  //   its value (the desired edge length) is at index [i + sizegriddim[0] *
+  //   (j + sizegriddim[1] * k)].  The function is trilinear in each cell.
+  REAL *sizegridlist;
+  int sizegriddim[3];
+  REAL sizegridorigin[3];
+  REAL sizegridstep[3];
  
   // 'tetrahedronlist':  An array of tetrahedron corners.  The first 
   //   tetrahedron's first corner is at index [0], followed by its other 
@@ -215,8 +269,12 @@ public:
   // 'neighborlist':  An array of tetrahedron neighbors; 4 ints per element. 
   // 'tet2facelist':  An array of tetrahedron face indices; 4 ints per element.
   // 'tet2edgelist':  An array of tetrahedron edge indices; 6 ints per element.
+  // 'tetrahedronqualitylist':  An array of tetrahedron qualities; 5 REALs per
+  //   element: volume, smallest and largest dihedral angle (in degree),
+  //   radius-edge ratio, and aspect ratio.  Output only (-u).
   int  *tetrahedronlist;
   REAL *tetrahedronattributelist;
+  REAL *tetrahedronqualitylist;
   REAL *tetrahedronvolumelist;
   int  *neighborlist;
   int  *tet2facelist;
@@ -325,6 +383,22 @@ public:
   // A callback function.
   TetSizeFunc tetunsuitable;
 
+  // A callback function (and its handle) of a mesh sizing function (-m).
+  //   If it is combined with 'sizegridlist', the smaller size is used.  A
+  //   background mesh is not used if either of them is given.  The callback
+  //   is never called by more than one thread at a time, so it need not be
+  //   thread-safe.
+  void *sizehandle;
+  PointSizeFunc sizefunc;
+
+  // Callback functions (and their handle) for streaming the output. The
+  //   batch size is 'sinkbatchsize' items, 0 means the default (4096).
+  void *sinkhandle;
+  PointSinkFunc pointsink;
+  TetSinkFunc tetsink;
+  FaceSinkFunc facesink;
+  int sinkbatchsize;
+
   // Input & output routines.
   bool load_node_call(FILE* infile, int markers, int uvflag, char*);
   bool load_node(char*);
@@ -334,6 +408,7 @@ public:
   bool load_vol(char*);
   bool load_var(char*);
   bool load_mtr(char*);
+  bool load_sizegrid(char*);
   bool load_pbc(char*);
   bool load_poly(char*);
   bool load_off(char*);
@@ -373,6 +448,8 @@ public:
   // Initialize routine.
   void initialize()
   {
+    int i;
+
     firstnumber = 0;
     mesh_dim = 3;
     useindex = 1;
@@ -380,15 +457,21 @@ public:
     pointlist = (REAL *) NULL;
     pointattributelist = (REAL *) NULL;
     pointmtrlist = (REAL *) NULL;
+    sizegridlist = (REAL *) NULL;
     pointmarkerlist = (int *) NULL;
 	point2tetlist = (int *) NULL;
     pointparamlist = (pointparam *) NULL;
     numberofpoints = 0;
     numberofpointattributes = 0;
     numberofpointmtrs = 0;
+    for (i = 0; i < 3; i++) {
+      sizegriddim[i] = 0;
+      sizegridorigin[i] = sizegridstep[i] = 0.0;
+    }
 
     tetrahedronlist = (int *) NULL;
     tetrahedronattributelist = (REAL *) NULL;
+    tetrahedronqualitylist = (REAL *) NULL;
     tetrahedronvolumelist = (REAL *) NULL;
     neighborlist = (int *) NULL;
 	tet2facelist = (int *) NULL;
@@ -438,6 +521,15 @@ public:
 
     tetunsuitable = NULL;
 
+    sizehandle = NULL;
+    sizefunc = NULL;
+
+    sinkhandle = NULL;
+    pointsink = NULL;
+    tetsink = NULL;
+    facesink = NULL;
+    sinkbatchsize = 0;
+
     geomhandle = NULL;
     getvertexparamonedge = NULL;
     getsteineronedge = NULL;
@@ -461,6 +553,9 @@ public:
     if (pointmtrlist != (REAL *) NULL) {
       delete [] pointmtrlist;
     }
+    if (sizegridlist != (REAL *) NULL) {
+      delete [] sizegridlist;
+    }
     if (pointmarkerlist != (int *) NULL) {
       delete [] pointmarkerlist;
     }
@@ -477,6 +572,9 @@ public:
     if (tetrahedronattributelist != (REAL *) NULL) {
       delete [] tetrahedronattributelist;
     }
+    if (tetrahedronqualitylist != (REAL *) NULL) {
+      delete [] tetrahedronqualitylist;
+    }
     if (tetrahedronvolumelist != (REAL *) NULL) {
       delete [] tetrahedronvolumelist;
     }
@@ -602,14 +700,20 @@ public:
   int plc;                                                         // '-p', 0.
   int psc;                                                         // '-s', 0.
   int refine;                                                      // '-r', 0.
+  int incremental;                                                 // '-y', 0.
   int quality;                                                     // '-q', 0.
+  int priorityrefine;                                              // '-P', 0.
   int nobisect;                                                    // '-Y', 0.
   int coarsen;                                                     // '-R', 0.
   int weighted;                                                    // '-w', 0.
   int brio_hilbert;                                                // '-b', 1.
+  int locategrid;                                                  // '-G', 0.
+  int relocatepoints;                                              // '-Z', 0.
   int incrflip;                                                    // '-l', 0.
   int flipinsert;                                                  // '-L', 0.
   int metric;                                                      // '-m', 0.
+  REAL surfacesize;                                              // '-m', 0.0.
+  REAL sizegrowth;                                              // '-m/', 0.0.
   int varvolume;                                                   // '-a', 0.
   int fixedvolume;                                                 // '-a', 0.
   int regionattrib;                                                // '-A', 0.
@@ -617,6 +721,7 @@ public:
   int use_equatorial_lens;                                        // '-Dl', 0.
   int insertaddpoints;                                             // '-i', 0.
   int diagnose;                                                    // '-d', 0.
+  int preflight;                                                   // '-W', 0.
   int convex;                                                      // '-c', 0.
   int nomergefacet;                                                // '-M', 0.
   int nomergevertex;                                               // '-M', 0.
@@ -629,12 +734,17 @@ public:
   int voroout;                                                     // '-v', 0.
   int meditview;                                                   // '-g', 0.
   int vtkview;                                                     // '-k', 0.
+  int tetout;                                                      // '-t', 0.
+  int qualout;                                                     // '-u', 0.
+  int qualstat;                                                   // '-u1', 0.
   int nobound;                                                     // '-B', 0.
   int nonodewritten;                                               // '-N', 0.
   int noelewritten;                                                // '-E', 0.
   int nofacewritten;                                               // '-F', 0.
   int noiterationnum;                                              // '-I', 0.
   int nojettison;                                                  // '-J', 0.
+  int freeinput;                                                   // '-U', 0.
+  int numthreads;                                                  // '-j', 1.
   int docheck;                                                     // '-C', 0.
   int quiet;                                                       // '-Q', 0.
   int verbose;                                                     // '-V', 0.
@@ -674,6 +784,7 @@ public:
   REAL optminslidihed;                                               // 179.0.  
   REAL epsilon;                                               // '-T', 1.0e-8.
   REAL coarsen_percent;                                         // -R1/#, 1.0.
+  REAL checksample;                                             // '-C', 1.0.
 
   // Strings of command line arguments and input/output file names.
   char commandline[1024];
@@ -681,6 +792,8 @@ public:
   char outfilename[1024];
   char addinfilename[1024];
   char bgmeshfilename[1024];
+  char oldsurffilename[1024];
+  char editfilename[1024];
 
   // Read an additional tetrahedral mesh and treat it as holes [2018-07-30].
   int hole_mesh;                                                   // '-H', 0.
@@ -717,12 +830,18 @@ public:
     plc = 0;
     psc = 0;
     refine = 0;
+    incremental = 0;
     quality = 0;
+    priorityrefine = 0;
     nobisect = 0;
     coarsen = 0;
     metric = 0;
+    surfacesize = 0.0;
+    sizegrowth = 0.0;
     weighted = 0;
     brio_hilbert = 1;
+    locategrid = 0;
+    relocatepoints = 0;
     incrflip = 0;
     flipinsert = 0;
     varvolume = 0;
@@ -734,6 +853,7 @@ public:
     cdtrefine = 0;
     use_equatorial_lens = 0; // -Dl
     diagnose = 0;
+    preflight = 0;
     convex = 0;
     zeroindex = 0;
     facesout = 0;
@@ -742,6 +862,9 @@ public:
     voroout = 0;
     meditview = 0;
     vtkview = 0;
+    tetout = 0;
+    qualout = 0;
+    qualstat = 0;
     nobound = 0;
     nonodewritten = 0;
     noelewritten = 0;
@@ -750,6 +873,8 @@ public:
     nomergefacet = 0;
     nomergevertex = 0;
     nojettison = 0;
+    freeinput = 0;
+    numthreads = 1;
     docheck = 0;
     quiet = 0;
     verbose = 0;
@@ -788,6 +913,7 @@ public:
     optminslidihed = 179.00;
     epsilon = 1.0e-8;
     coarsen_percent = 1.0;
+    checksample = 1.0;
     object = NODES;
 
     commandline[0] = '\0';
@@ -795,6 +921,8 @@ public:
     outfilename[0] = '\0';
     addinfilename[0] = '\0';
     bgmeshfilename[0] = '\0';
+    oldsurffilename[0] = '\0';
+    editfilename[0] = '\0';
 
     hole_mesh = 0;
     hole_mesh_filename[0] = '\0';
@@ -829,13 +957,39 @@ public:
 // filter" in each predicate. It estimates the maximal possible error in all //
 // cases.  So it can safely and quickly answer many easy cases.              //
 //                                                                           //
+// The options (-X) and the static filters of orient3d() and insphere() are //
+// calculated from the input by exactinit(),  and are kept in a context, so  //
+// different meshes can be generated at the same time (by several threads).  //
+// Each tetgenmesh owns one context (see tetgenmesh::predctx).               //
+//                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
+class predicatecontext {
+
+public:
+
+  int use_inexact_arith;                                           // '-X', 0.
+  int use_static_filter;                                          // '-X1', 1.
+  REAL o3dstaticfilter;                     // Static filter for orient3d().
+  REAL ispstaticfilter;                     // Static filter for insphere().
+
+  // The default context does not use the static filters,  they are only
+  //   valid after exactinit() is called.
+  predicatecontext() : use_inexact_arith(0), use_static_filter(0), 
+    o3dstaticfilter(0), ispstaticfilter(0) {}
+};
+
+void exactinit(predicatecontext*, int, int, int, REAL, REAL, REAL);
+REAL orient3d(predicatecontext*, REAL *pa, REAL *pb, REAL *pc, REAL *pd);
+REAL insphere(predicatecontext*, REAL *pa, REAL *pb, REAL *pc, REAL *pd, 
+              REAL *pe);
+REAL orient4d(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe,
+              REAL ah, REAL bh, REAL ch, REAL dh, REAL eh);
+
+// The same functions with a shared default context (not thread-safe).
 void exactinit(int, int, int, REAL, REAL, REAL);
 REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd);
 REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe);
-REAL orient4d(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe,
-              REAL ah, REAL bh, REAL ch, REAL dh, REAL eh);
 
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                           //
@@ -1060,12 +1214,39 @@ public:
 //   to be traversed.  pathitemsleft is the number of items that remain to   //
 //   be traversed in pathblock.                                              //
 //                                                                           //
+// Several threads may allocate and deallocate items at the same time by the //
+//   functions alloc(tid) and dealloc(item, tid), after threadinit() is      //
+//   called.  Each thread owns an arena (aligned to a cache line) with its   //
+//   own stack of dead items and a run of fresh items, it takes and puts     //
+//   items there without a lock.  An item freed by thread 'tid' goes to the  //
+//   arena of 'tid', no matter which thread allocated it.  If an arena holds //
+//   too many dead items, a part of them is pushed onto 'remotestack' by a   //
+//   compare-and-swap, a thread with an empty arena takes the whole stack by //
+//   an atomic exchange.  Only if it is empty, the thread takes a run of     //
+//   fresh items from the blocks (or dead items from deaditemstack) in a     //
+//   critical section.  The runs are cut from the shared blocks, hence       //
+//   traverse() visits all items as before.  threadmerge() moves the dead    //
+//   items of all arenas and of 'remotestack' into deaditemstack and updates //
+//   the counter 'items'.  It must be called after the parallel section.     //
+//   The unused fresh items of the runs are zero-filled, so alloc(tid) only  //
+//   fits pools in which a zero-filled item reads as dead (tets, subfaces).  //
+//                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
   class memorypool {
 
   public:
 
+    // A thread arena, padded to a cache line to avoid false sharing.
+    class threadarena {
+    public:
+      void *deaditemstack, *deaditemtail;
+      void *nextitem;
+      long items;
+      int  deaditems, unallocateditems;
+      char pad[64 - 3 * sizeof(void *) - sizeof(long) - 2 * sizeof(int)];
+    };
+
     void **firstblock, **nowblock;
     void *nextitem;
     void *deaditemstack;
@@ -1077,15 +1258,24 @@ public:
     long items, maxitems;
     int  unallocateditems;
     int  pathitemsleft;
+    threadarena *arenas;
+    void *arenablock;
+    void *remotestack;
+    int  threads;
 
     memorypool();
     memorypool(int, int, int, int);
     ~memorypool();
     
     void poolinit(int, int, int, int);
+    void *allocblock();
     void restart();
     void *alloc();
     void dealloc(void*);
+    void threadinit(int);
+    void *alloc(int);
+    void dealloc(void*, int);
+    void threadmerge();
     void traversalinit();
     void *traverse();
   };  
@@ -1115,6 +1305,52 @@ public:
       nextitem(0) {}
   };
 
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// bvhnode                                                                   //
+//                                                                           //
+// A node of the bounding volume hierarchy (BVH) of a set of triangles (or  //
+// tetrahedra).  It holds the objects 'first', ..., 'first' + 'count' - 1 of //
+// an index array and their bounding box.  A node with at most BVHLEAFSIZE  //
+// objects is a leaf. Otherwise, its left child is the next node, and        //
+// 'right' is the index of its right child.                                  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+  class bvhnode {
+  public:
+    REAL bbox[6]; // xmin, ymin, zmin, xmax, ymax, zmax.
+    int first, count, right;
+  };
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// qualstats                                                                 //
+//                                                                           //
+// The quality statistics of the tetrahedra (see getqualitystatistics()).    //
+// Degenerated (zero volume) and inverted (negative volume) tets only count  //
+// for the volume and edge lengths.  The bins of the histograms are given    //
+// by 'aspectbounds', 'radiusbounds', 'dihedbounds', and by ten degrees for  //
+// the face angles.                                                          //
+// volumetable[i] counts the volumes in [10^(i-30), 10^(i-29)), the first    //
+// and the last bins are open.                                               //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+  class qualstats {
+  public:
+    long ntets, degenerated, inverted;
+    REAL totalvolume, minvolume, maxvolume;
+    REAL shortest, longest;                  // edge length.
+    REAL minaspect, maxaspect;               // aspect ratio.
+    REAL minradius, maxradius;               // radius-edge ratio.
+    REAL minfaceangle, maxfaceangle;         // in degree.
+    REAL mindihedral, maxdihedral;           // in degree.
+    unsigned long aspecttable[12], radiustable[12];
+    unsigned long faceangletable[18], dihedangletable[18];
+    unsigned long volumetable[40];
+  };
+
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                           //
 // insertvertexflags                                                         //
@@ -1241,6 +1477,9 @@ public:
     int maxiter;  // Maximum smoothing iterations (disabled by -1).
     int smthiter; // Performed iterations.
 
+    // The seed of the random search directions (NULL: use 'randomseed').
+    unsigned long *seed;
+
 
     optparameters() {
       max_min_volume = 0;
@@ -1253,10 +1492,63 @@ public:
       searchstep = 0.01;
       maxiter = -1;   // Unlimited smoothing iterations.
       smthiter = 0;
+      seed = NULL;
 
     }
   };
 
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// insertthread                                                              //
+//                                                                           //
+// The work data of one thread in the parallel point insertion (-j), see the //
+// routine insertpoint_par().  A tet is locked by one of the entries of the  //
+// shared table 'locks' (of size 'lockmask' + 1),  'locklist' stores the     //
+// indices of the entries taken by this thread.                              //
+//                                                                           //
+// In Delaunay refinement (see splittetrahedra_par()), 'refinetet' is the    //
+// bad tet being split, 'queuetetlist' collects the new tets, and 'smlen',   //
+// 'parentpt' return the shortest edge at the new vertex.                    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+  class insertthread {
+
+  public:
+
+    arraypool *cavetetlist, *cavebdrylist, *caveoldtetlist;
+    arraypool *newtetlist, *busytetlist, *locklist;
+    triface recenttet; // The start of the next walk.
+    triface starttet;  // The start if 'recenttet' is dead.
+    triface refinetet; // The bad tet (refinement only).
+    arraypool *queuetetlist;
+    point parentpt;
+    REAL smlen;
+    unsigned long seed;
+    long hullsize;
+    long locatecount, locatesteps;
+    long flip14count, flip26count, flipn2ncount;
+    int tid;
+
+    int *locks;
+    int lockmask;
+
+    insertthread() {
+      cavetetlist = cavebdrylist = caveoldtetlist = NULL;
+      newtetlist = busytetlist = locklist = NULL;
+      queuetetlist = NULL;
+      parentpt = NULL;
+      smlen = 0.0;
+      seed = 0;
+      hullsize = 0l;
+      locatecount = locatesteps = 0l;
+      flip14count = flip26count = flipn2ncount = 0l;
+      tid = 0;
+      locks = NULL;
+      lockmask = 0;
+    }
+  };
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                           //
@@ -1278,6 +1570,14 @@ public:
                      ENCVERTEX, ENCSEGMENT, ENCSUBFACE, NEARVERTEX, NONREGULAR,
                      INSTAR, BADELEMENT};
 
+  // Labels that signify the type of a defect of the input facets (-W).
+  enum inputdefect {INVALIDINDEX, DEGENERATEFACE, DUPLICATEFACE, INTERSECTFACE,
+                    OPENEDGE, NONMANIFOLDEDGE};
+
+  // Labels that signify the kind of an item checked by checkitems() (-C).
+  enum checkkind {CHECKTET, CHECKSUBFACE, CHECKTETSEG, CHECKSUBSEG,
+                  CHECKSEGVERTEX, CHECKDELAUNAY};
+
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                           //
 // Variables of TetGen                                                       //
@@ -1301,6 +1601,35 @@ public:
   // Memorypools to store bad-quality (or encroached) elements.
   memorypool *badtetrahedrons, *badsubfacs, *badsubsegs;
 
+  // A uniform grid of 'gridsize[0] x gridsize[1] x gridsize[2]' cubes (the
+  //   edge length is 'gridstep') over the bounding box (-G).  Each cube keeps
+  //   a tet created at a point in it (it may be dead now), or NULL.  The
+  //   grid is made for 'gridpoints' points, it is re-made when the number of
+  //   points is doubled.
+  tetrahedron **locategrid;
+  int gridsize[3];
+  REAL gridstep;
+  long gridpoints;
+
+  // A bounding volume hierarchy of the tetrahedra (of a background mesh),
+  //   built by maketetbvh(). The tets in node 'tetbvh[i]' are 'bvhtets[j]',
+  //   j = tetbvh[i].first, ..., tetbvh[i].first + tetbvh[i].count - 1.
+  bvhnode *tetbvh;
+  tetrahedron **bvhtets;
+
+  // A mesh sizing function (-m) is used if 'usesizefunc' is set. It is given
+  //   by 'in->sizefunc', 'in->sizegridlist', or the distance to the boundary
+  //   (-m#/#),  which is sampled on the grid 'distgrid' (it is laid out like
+  //   'in->sizegridlist').  See getsizefunction().
+  int usesizefunc;
+  REAL *distgrid;
+  int distgriddim[3];
+  REAL distgridorigin[3], distgridstep[3];
+
+  // The buckets of the priority queue of bad-quality tetrahedra (-P). The
+  //   items are stored in 'badtetrahedrons'.  Bucket 63 is the worst.
+  badface *tetquefront[64], *tetquetail[64];
+
   // A memorypool to store faces to be flipped.
   memorypool *flippool;
   arraypool *unflipqueue;
@@ -1358,6 +1687,7 @@ public:
   int nonconvex;                               // Is current mesh non-convex?
   int autofliplinklevel;        // The increase of link levels, default is 1.
   int useinsertradius;       // Save the insertion radius for Steiner points.
+  int usetetpriority;        // Are bad tets queued by priority (-P)?
   long samples;               // Number of random samples for point location.
   unsigned long randomseed;                    // Current random number seed.
   REAL cosmaxdihed, cosmindihed;    // The cosine values of max/min dihedral.
@@ -1383,7 +1713,9 @@ public:
   long flip14count, flip26count, flipn2ncount;
   long flip23count, flip32count, flip44count, flip41count;
   long flip31count, flip22count;
+  long locatecount, locatesteps, gridjumpcount;         // Point locations.
   unsigned long totalworkmemory;      // Total memory used by working arrays.
+  unsigned long releasedmemory;          // Memory released from the input.
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1405,6 +1737,9 @@ public:
   static int sorgpivot [6], sdestpivot[6], sapexpivot[6];
   static int snextpivot[6];
 
+  // Bounds of the bins of the quality histograms.
+  static REAL aspectbounds[11], radiusbounds[11], dihedbounds[19];
+
   void inittables();
 
   // Primitives for tetrahedra.
@@ -1585,7 +1920,7 @@ public:
 
   void makeindex2pointmap(point*&);
   void makepoint2submap(memorypool*, int*&, face*&);
-  void maketetrahedron(triface*);
+  void maketetrahedron(triface*, tetrahedron *space = NULL);
   void makeshellface(memorypool*, face*);
   void makepoint(point*, enum verttype);
 
@@ -1615,6 +1950,13 @@ public:
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
+  // The context of the robust predicates of this mesh, set by exactinit().
+  predicatecontext predctx;
+
+  // Robust predicates (use 'predctx')
+  inline REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd);
+  inline REAL insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL *pe);
+
   // Symbolic perturbations (robust)
   REAL insphere_s(REAL*, REAL*, REAL*, REAL*, REAL*);
   REAL orient4d_s(REAL*, REAL*, REAL*, REAL*, REAL*, 
@@ -1652,6 +1994,7 @@ public:
   bool tetalldihedral(point, point, point, point, REAL*, REAL*, REAL*);
   void tetallnormal(point, point, point, point, REAL N[4][3], REAL* volume);
   REAL tetaspectratio(point, point, point, point);
+  void tetquality(int n, REAL *pts, REAL *qual, REAL *cosdd);
   bool circumsphere(REAL*, REAL*, REAL*, REAL*, REAL* cent, REAL* radius);
   bool orthosphere(REAL*,REAL*,REAL*,REAL*,REAL,REAL,REAL,REAL,REAL*,REAL*);
   void tetcircumcenter(point tetorg, point tetdest, point tetfapex,
@@ -1711,6 +2054,7 @@ public:
   int flipnm_post(triface*, int n, int nn, int, flipconstraints* fc);
 
   // Point insertion.
+  void shortedgewarning(point insertpt, point nearpt, REAL len);
   int  insertpoint(point, triface*, face*, face*, insertvertexflags*);
   void insertpoint_abort(face*, insertvertexflags*);
 
@@ -1772,6 +2116,7 @@ public:
 ///////////////////////////////////////////////////////////////////////////////
 
   void transfernodes();
+  void releaseinput();
 
   // Point sorting.
   int  transgc[8][3][8], tsb1mod3[8];
@@ -1781,12 +2126,21 @@ public:
   void hilbert_sort3(point* vertexarray, int arraysize, int e, int d,
                      REAL, REAL, REAL, REAL, REAL, REAL, int depth);
   void brio_multiscale_sort(point*,int,int threshold,REAL ratio,int* depth);
+  unsigned long long counterrandom(unsigned long long seed,
+                                   unsigned long long counter);
+  void randompermute(point *ptarray, int n, unsigned long long seed);
+  void sortpoints(point *ptarray, int n);
 
   // Point location.
   unsigned long randomnation(unsigned int choices);
+  unsigned long randomnation(unsigned int choices, unsigned long *seed);
   void randomsample(point searchpt, triface *searchtet);
+  void makelocategrid();
+  int getgridcell(point searchpt);
+  int getgridtet(point searchpt, triface *searchtet);
   enum locateresult locate(point searchpt, triface *searchtet, 
-                           int chkencflag = 0);
+                           int chkencflag = 0, unsigned long *seed = NULL,
+                           insertthread *ith = NULL);
 
   // Incremental flips.
   void flippush(badface*&, triface*);
@@ -1794,6 +2148,17 @@ public:
 
   // Incremental Delaunay construction.
   void initialdelaunay(point pa, point pb, point pc, point pd);
+  int  relocatepoints(point *ptarray, int n, point *slots);
+  void restorepoints(point *slots, int n);
+  void skipinsertpoint(point insertpt, point existpt, int iloc);
+  int  locktet(triface*, insertthread*);
+  void unlocktet(triface*, insertthread*);
+  void unlockall(insertthread*);
+  enum locateresult insertpoint_par(point insertpt, point *nearpt,
+                                    insertthread *ith);
+  void insertpoint_par_abort(insertthread *ith);
+  void insertpoints_par(point *ptarray, int start, int n, int nparts);
+  void sorttetrahedra(int nparts);
   void incrementaldelaunay(clock_t&);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1820,9 +2185,14 @@ public:
   void removesmallangles();
   void meshsurface();
 
-  void interecursive(shellface** subfacearray, int arraysize, int axis,
-                     REAL, REAL, REAL, REAL, REAL, REAL, int* internum);
+  void buildbvh(REAL *boxes, int *idx, bvhnode *nodes, int nd, int first,
+                int count, int hasbox = 0);
+  int  sharevertcheck(point *p1, point *p2);
+  void interfacebvh(point *tripts, REAL *boxes, int *idx, bvhnode *nodes,
+                    int a, int b, arraypool *stack, arraypool *pairlist);
+  int  intertriangles(point *tripts, int n, int* &pairs);
   void detectinterfaces();
+  int  checkinput(tetgenio *out);
 
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                           //
@@ -1971,13 +2341,28 @@ public:
 
   void carveholes();
 
+  void getfacekey(triface *face, int *v);
+  void sortfacekeys(int *recs, int n);
   void reconstructmesh();
 
+  int  searchtetface(int *facetab, int tabsize, int *v);
+  void matchpoints(REAL *pts1, int n1, REAL *pts2, int n2, int *map);
+  int  assignindices(char *keep, int nold, int nnew, int *oldpos, int *newpos);
+  int  remeshregion(tetgenio *oldsurf, tetgenio *surf, tetgenio *newin);
+
   int  search_face(point p0, point p1, point p2, triface &tetloop);
   int  search_edge(point p0, point p1, triface &tetloop);
-  int  scoutpoint(point, triface*, int randflag);
+  void maketetbvh();
+  int  pointintet(point, triface*, REAL *ori);
+  int  scoutpoint(point, triface*, int randflag, unsigned long *seed = NULL);
   REAL getpointmeshsize(point, triface*, int iloc);
   void interpolatemeshsize();
+  REAL gridinterpolate(REAL *grid, int *dim, REAL *origin, REAL *step,
+                       REAL *pt);
+  REAL tridistance(REAL *pt, REAL *pa, REAL *pb, REAL *pc);
+  void makedistancegrid();
+  REAL getsizefunction(REAL *pt);
+  void applysizefunction();
   void out_points_to_cells_map(); // in flow_main()
 
   void insertconstrainedpoints(point *insertarray, int arylen, int rejflag);
@@ -2030,6 +2415,8 @@ public:
   void save_facetpoint_insradius(point facpt, point parentpt, REAL r);
   void enqueuesubface(memorypool*, face*);
   void enqueuetetrahedron(triface*);
+  int tetpriority(triface*);
+  badface* dequeuetetrahedron();
 
   int checkseg4encroach(point pa, point pb, point checkpt);
   int checkseg4split(face *chkseg, point&, int&);
@@ -2042,7 +2429,10 @@ public:
   void repairencfacs(int chkencflag);
 
   int checktet4split(triface *chktet, int& qflag, REAL *ccent);
+  void checktets4split(badface *chktets, int n);
   int splittetrahedron(triface* splittet,int qflag,REAL *ccent, int);
+  long splittetrahedra_par(badface *batch, int n, insertthread *ths,
+                           int nparts, int chkencflag);
   void repairbadtets(int chkencflag);
 
   void delaunayrefinement();
@@ -2060,6 +2450,7 @@ public:
   long improvequalitybyflips();
 
   int  smoothpoint(point smtpt, arraypool*, int ccw, optparameters *opm);
+  long smoothslivers(arraypool *sliverlist, optparameters *opm);
   long improvequalitybysmoothing(optparameters *opm);
 
   int  splitsliver(triface *, REAL, int);
@@ -2074,6 +2465,17 @@ public:
 ///////////////////////////////////////////////////////////////////////////////
 
   // Mesh validations.
+  int checksampled(unsigned long *seed);
+  int checkmeshtet(tetrahedron *tet, int topoflag, int report, int *notes);
+  int checkshellface(shellface *sh, int report, int *notes);
+  int checktetsegs(tetrahedron *tet, int report, int *notes);
+  int checksubseg(shellface *sh, int report, int *notes);
+  int checksegvertex(point pa, int report, int *notes);
+  int checkdelaunaytet(tetrahedron *tet, int perturb, int report, int *notes);
+  int checkitem(enum checkkind kind, void *item, int flag, int report,
+                int *notes);
+  int checkitems(enum checkkind kind, void **items, long n, int flag,
+                 int *notes);
   int checkmesh(int topoflag);
   int checkshells();
   int checksegments();
@@ -2083,6 +2485,9 @@ public:
 
   //  Mesh statistics.
   void printfcomma(unsigned long n);
+  int  tetqualitystats(tetrahedron **tlist, int n, REAL *pts, REAL *qual,
+                       REAL *cosdd, qualstats *qs, REAL *volsum);
+  void getqualitystatistics(qualstats *qs, int report);
   void qualitystatistics();
   void memorystatistics();
   void statistics();
@@ -2100,6 +2505,7 @@ public:
   void outnodes(tetgenio*);
   void outmetrics(tetgenio*);
   void outelements(tetgenio*);
+  void outqualities(tetgenio*);
   void outfaces(tetgenio*);
   void outhullfaces(tetgenio*);
   void outsubfaces(tetgenio*);
@@ -2110,6 +2516,15 @@ public:
   void outsmesh(char*);
   void outmesh2medit(char*);
   void outmesh2vtk(char*);
+  void outmesh2vtu(char*);
+  int  formatrecord(char*, int, void*);
+  void writerecords(FILE*, int, void**, int);
+  void writebigendian(FILE*, void*, int, int);
+  REAL* getallqualities();
+  void outmesh2tet(char*);
+  void outqualityitem(FILE*, const char*, REAL, REAL, REAL*, unsigned long*,
+                      int, int);
+  void outqualitystatistics(char*);
 
 
 
@@ -2129,6 +2544,12 @@ public:
     tetrahedrons = subfaces = subsegs = points = NULL;
     badtetrahedrons = badsubfacs = badsubsegs = NULL;
     tet2segpool = tet2subpool = NULL;
+    locategrid = NULL;
+    gridpoints = 0l;
+    tetbvh = NULL;
+    bvhtets = NULL;
+    usesizefunc = 0;
+    distgrid = NULL;
     flippool = NULL;
 
     dummypoint = NULL;
@@ -2165,6 +2586,7 @@ public:
     nonconvex = 0;
     autofliplinklevel = 1;
     useinsertradius = 0;
+    usetetpriority = 0;
     samples = 0l;
     randomseed = 1l;
     minfaceang = minfacetdihed = PI;
@@ -2184,7 +2606,9 @@ public:
     flip14count = flip26count = flipn2ncount = 0l;
     flip23count = flip32count = flip44count = flip41count = 0l;
     flip22count = flip31count = 0l;
+    locatecount = locatesteps = gridjumpcount = 0l;
     totalworkmemory = 0l;
+    releasedmemory = 0l;
 
 
   } // tetgenmesh()
@@ -2211,6 +2635,17 @@ public:
       delete tet2subpool;
     }
 
+    if (locategrid != NULL) {
+      delete [] locategrid;
+    }
+    if (tetbvh != NULL) {
+      delete [] tetbvh;
+      delete [] bvhtets;
+    }
+    if (distgrid != NULL) {
+      delete [] distgrid;
+    }
+
     if (badtetrahedrons) {
       delete badtetrahedrons;
     }
@@ -2296,14 +2731,29 @@ public:
 // saved to file(s). If 'bgmin' != NULL, it contains a background mesh which //
 // defines a mesh size function.                                             //
 //                                                                           //
+// If the callback functions 'pointsink', 'tetsink', or 'facesink' of 'out'  //
+// are set, the points, tetrahedra, or boundary faces are passed to them in  //
+// batches instead of being copied into the lists of 'out'.                  //
+//                                                                           //
+// If the -U switch is used, the point, facet, and element lists of 'in' are //
+// released as soon as the mesh has been built from them (see releaseinput() //
+// in tetgen.cxx).  Their numbers and the marker lists are kept.             //
+//                                                                           //
+// If the -ry switches are used, 'oldsurfin' contains the surface which the //
+// mesh 'in' was generated from, and 'editin' contains its edited version.   //
+// Only the region of the mesh changed by the edit is re-meshed (see remesh- //
+// region() in tetgen.cxx).                                                  //
+//                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
 void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out, 
-                    tetgenio *addin = NULL, tetgenio *bgmin = NULL);
+                    tetgenio *addin = NULL, tetgenio *bgmin = NULL,
+                    tetgenio *oldsurfin = NULL, tetgenio *editin = NULL);
 
 #ifdef TETLIBRARY
 void tetrahedralize(char *switches, tetgenio *in, tetgenio *out,
-                    tetgenio *addin = NULL, tetgenio *bgmin = NULL);
+                    tetgenio *addin = NULL, tetgenio *bgmin = NULL,
+                    tetgenio *oldsurfin = NULL, tetgenio *editin = NULL);
 #endif // #ifdef TETLIBRARY
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3432,6 +3882,23 @@ inline REAL tetgenmesh::norm2(REAL x, REAL y, REAL z)
   return (x) * (x) + (y) * (y) + (z) * (z);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// Robust predicates of this mesh.                                           //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+inline REAL tetgenmesh::orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd)
+{
+  return ::orient3d(&predctx, pa, pb, pc, pd);
+}
+
+inline REAL tetgenmesh::insphere(REAL *pa, REAL *pb, REAL *pc, REAL *pd, 
+                                 REAL *pe)
+{
+  return ::insphere(&predctx, pa, pb, pc, pd, pe);
+}
+
 
 
 #endif // #ifndef tetgenH